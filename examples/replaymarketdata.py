@@ -0,0 +1,44 @@
+import argparse
+import csv
+import sys, os
+sys.path.append(os.path.join(os.path.dirname(sys.path[0]),'build'))
+from BondPricing import *
+
+# Replays a recorded market data file against a bond universe and reports tick-to-price
+# latency. The bond file is a CSV with the header
+#     bond_id,curve_id,face_value,coupon,issue_date,maturity_date,frequency
+# where dates are dd/mm/yyyy and frequency is one of Annual, SemiAnnual, Quarterly, Monthly.
+# Curves start empty and are built up by the CURVE records of the market data file.
+
+parser = argparse.ArgumentParser(description='Replay recorded curve and quote ticks through the pricer')
+parser.add_argument('--bonds', required=True, help='bond universe CSV')
+parser.add_argument('--ticks', required=True, help='recorded market data file')
+parser.add_argument('--out', required=True, help='file to stream prices and yields to')
+parser.add_argument('--valuation-date', required=True, help='pricing date as dd/mm/yyyy')
+parser.add_argument('--recorded-speed', action='store_true', help='replay at recorded pace instead of flat out')
+args = parser.parse_args()
+
+replay = MarketDataReplay(Date(args.valuation_date))
+curves = {}
+bonds = []
+with open(args.bonds) as bond_file:
+    for row in csv.DictReader(bond_file):
+        if row['curve_id'] not in curves:
+            curves[row['curve_id']] = YieldCurve([])
+            replay.addCurve(row['curve_id'], curves[row['curve_id']])
+        bond = GeneralTermBond(
+            face_value=float(row['face_value']),
+            coupon=float(row['coupon']),
+            maturity_date=Date(row['maturity_date']),
+            issue_date=Date(row['issue_date']),
+            schedule=ScheduleRules(Frequency.names[row['frequency']]),
+            yield_curve=curves[row['curve_id']]
+        )
+        replay.addBond(row['bond_id'], bond)
+        bonds.append(bond)
+
+stats = replay.run(args.ticks, args.out, recorded_speed=args.recorded_speed)
+print('ticks {} prices {} in {:.3f}s ({:.0f} ticks/s)'.format(
+    stats.ticks, stats.prices, stats.elapsed_seconds, stats.ticks_per_second))
+print('tick-to-price latency us: p50 {:.2f} p90 {:.2f} p99 {:.2f} p99.9 {:.2f} max {:.2f}'.format(
+    stats.latency_p50, stats.latency_p90, stats.latency_p99, stats.latency_p999, stats.latency_max))
@@ -11,9 +11,9 @@
 
 #include "cashflow.hpp"
 #include "date.hpp"
+#include "schedule.hpp"
 
 namespace BondLibrary {
-using CashFlows = std::vector<CashFlow>;
 using CashFlowsPy = boost::python::list;
 using CashFlowOpt = std::optional<const CashFlow>;
 class BaseBond {
@@ -27,6 +27,16 @@ public:
         const Date settlement_date,
         const DayCountConvention daycount_convention
     );
+    BaseBond(
+        double face_value,
+        double coupon,
+        const Date maturity_date,
+        const Date issue_date,
+        const ScheduleRules& schedule,
+        const Date settlement_date,
+        const DayCountConvention daycount_convention,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+    );
     virtual ~BaseBond() {}
     double accruedAmount(Date settlement) const;
    // double yieldToMaturity(const double bond_price) const {return yieldToMaturity(bond_price, issue_date_);}
@@ -35,12 +45,15 @@ public:
     double getCurrentYield(double market_price) const;
     double modifiedDuration(const double rate, const Date date) const;
     bool isExpired() const;
+    bool isExpired(const Date& date) const;
+    const CashFlows& getCashFlows() const {return cashflows_;}
     CashFlowOpt getCashFlow(Date date) const;
     CashFlowOpt getNextCashFlow(const CashFlow& cashflow) const;
     CashFlowOpt getPreviousCashFlow(const CashFlow& cashflow) const;
     virtual double duration(const double rate, const Date date) const = 0;
     double notionalPresentValue(const double rate, Date date) const; 
 protected:
+    void checkSchedule() const;
     bool outOfRangeOrSlowConvergence(
         double rate_approx,
         double dfroot, 
@@ -0,0 +1,75 @@
+#ifndef BOND_BATCH_HPP
+#define BOND_BATCH_HPP
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "generaltermbond.hpp"
+#include "schedule.hpp"
+#include "yieldcurve.hpp"
+
+namespace BondLibrary {
+// A batch of GeneralTermBonds whose objects, cashflow schedules and result buffers are
+// carved out of one monotonic arena and handed back in a single release(), instead of
+// one heap allocation per bond and per schedule. Bonds returned by getBond and result
+// spans are only valid until release(); BatchBond handles check this and throw instead.
+class BondBatch {
+public:
+    BondBatch(size_t expected_bonds, size_t expected_cashflows);
+    BondBatch(const BondBatch&) = delete;
+    BondBatch& operator=(const BondBatch&) = delete;
+    ~BondBatch();
+    size_t addBond(
+        double face_value,
+        double coupon,
+        const Date maturity_date,
+        const Date issue_date,
+        const ScheduleRules& schedule,
+        const Date settlement_date,
+        YieldCurve& yield_curve,
+        const DayCountConvention
+    );
+    GeneralTermBond& getBond(size_t index) const;
+    GeneralTermBond& getBond(size_t index, size_t generation) const;
+    size_t size() const {return bonds_.size();}
+    size_t getGeneration() const {return generation_;}
+    std::span<const double> cleanPrices(const Date date);
+    void cleanPrices(const Date date, std::span<double> prices) const;
+    std::span<const double> durations(const Date date);
+    void durations(const Date date, std::span<double> durations) const;
+    void release();
+private:
+    void reserve();
+    std::span<double> resultBuffer();
+    size_t expected_bonds_;
+    size_t generation_ = 0; // bumped by every release()
+    std::pmr::monotonic_buffer_resource arena_;
+    std::pmr::vector<GeneralTermBond*> bonds_;
+    std::pmr::vector<double> results_;
+};
+
+// Handle to one bond of a batch, tied to the batch generation it was taken from so that
+// using it after the batch is released throws rather than reading recycled arena memory
+class BatchBond {
+public:
+    BatchBond(const BondBatch& batch, size_t index)
+        : batch_(&batch), index_(index), generation_(batch.getGeneration()) {
+        batch.getBond(index);
+    }
+    const GeneralTermBond& getBond() const {return batch_->getBond(index_, generation_);}
+    double cleanPrice(const Date date) const {return getBond().cleanPrice(date);}
+    double dirtyPrice(const Date date) const {return getBond().dirtyPrice(date);}
+    double getDuration(const Date date) const {return getBond().getDuration(date);}
+    double yieldToMaturity(const double bond_price, const Date date) const {
+        return getBond().yieldToMaturity(bond_price, date);
+    }
+    bool isExpired() const {return getBond().isExpired();}
+private:
+    const BondBatch* batch_;
+    size_t index_;
+    size_t generation_;
+};
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef BOND_STORE_HPP
+#define BOND_STORE_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "cashflow.hpp"
+#include "date.hpp"
+#include "generaltermbond.hpp"
+#include "yieldcurve.hpp"
+
+namespace BondLibrary {
+// Bond universe and yield curves published by one loader process into a POSIX shared
+// memory object, laid out flat as
+//     header | curve records | curve points | bond records | cashflows
+// Worker processes attach read-only and price straight off the mapped cashflows.
+// Curves are updated under a per-curve sequence lock, so readers always price off a
+// complete curve; bonds become visible once the header's bond count is bumped.
+// A bond can only be published against a curve id whose stored points match its own
+// YieldCurve, so workers never price it off a different curve.
+class BondStore {
+public:
+    BondStore(const std::string& name); // attach read-only to an existing store
+    BondStore(const std::string& name, size_t max_curves, size_t max_bonds, size_t max_cashflows);
+    BondStore(const BondStore&) = delete;
+    BondStore& operator=(const BondStore&) = delete;
+    ~BondStore();
+    static void remove(const std::string& name);
+    void publishCurve(const std::string& curve_id, const YieldCurve& curve);
+    void publishBond(const std::string& bond_id, const GeneralTermBond& bond, const std::string& curve_id);
+    double cleanPrice(const std::string& bond_id, const Date date) const;
+    double getDuration(const std::string& bond_id, const Date date) const;
+    size_t curveCount() const;
+    size_t bondCount() const;
+    constexpr static size_t max_id_length_ = 31;
+    constexpr static size_t max_curve_points_ = 128;
+private:
+    struct Header {
+        uint64_t magic;
+        uint64_t size;
+        uint64_t max_curves;
+        uint64_t max_bonds;
+        uint64_t max_cashflows;
+        uint64_t curve_count;
+        uint64_t bond_count;
+        uint64_t cashflow_count;
+    };
+    struct CurveRecord {
+        char id[max_id_length_ + 1];
+        uint64_t sequence; // odd while the loader is rewriting the points
+        uint64_t point_count;
+    };
+    struct BondRecord {
+        char id[max_id_length_ + 1];
+        uint64_t curve;
+        uint64_t first_cashflow;
+        uint64_t cashflow_count;
+    };
+    static size_t storeSize(size_t max_curves, size_t max_bonds, size_t max_cashflows);
+    void map(size_t size, bool writable);
+    void release();
+    void checkWritable() const;
+    size_t findCurve(const std::string& curve_id) const;
+    const BondRecord* lookupBond(const std::string& bond_id) const;
+    const BondRecord& findBond(const std::string& bond_id) const;
+    std::span<const YieldCurvePoint> snapshotCurve(size_t curve) const;
+    std::span<const CashFlow> cashflows(const BondRecord& bond) const;
+    CurveRecord* curveRecords() const;
+    YieldCurvePoint* curvePoints(size_t curve) const;
+    BondRecord* bondRecords() const;
+    CashFlow* cashflowStore() const;
+    std::string name_;
+    int fd_ = -1;
+    bool writable_ = false;
+    unsigned char* base_ = nullptr;
+    size_t mapped_size_ = 0;
+    Header* header_ = nullptr;
+    mutable std::unordered_map<std::string, size_t> bond_index_;
+    mutable size_t indexed_bonds_ = 0;
+    mutable std::vector<YieldCurvePoint> curve_snapshot_;
+};
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef CALENDAR_HPP
+#define CALENDAR_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/python.hpp>
+
+#include "date.hpp"
+
+namespace BondLibrary {
+enum class BusinessDayConvention {
+    Unadjusted,
+    Following,
+    ModifiedFollowing,
+    Preceding,
+    ModifiedPreceding
+};
+
+// Business days are held as one bit per day from 1 Jan of first_year_ to 31 Dec of
+// last_year_, so lookups are a single bit test and day counts are popcounts over a
+// running per-word total. Weekends are never business days.
+class Calendar {
+public:
+    Calendar(const std::string& name); // built in calendars: "UK", "US", "TARGET"
+    Calendar(const std::string& name, const boost::python::list& holidays);
+    void addHoliday(const Date& date);
+    void removeHoliday(const Date& date);
+    void loadHolidays(const std::string& path);
+    bool isBusinessDay(const Date& date) const;
+    bool isHoliday(const Date& date) const {return !isBusinessDay(date);}
+    int businessDaysBetween(const Date& from, const Date& to) const;
+    Date adjust(const Date& date, const BusinessDayConvention convention) const;
+    Date advance(const Date& date, int business_days) const;
+    const std::string& getName() const {return name_;}
+    constexpr static int first_year_ = 1950;
+    constexpr static int last_year_ = 2150;
+private:
+    void addWeekendsOnly();
+    void addBuiltInHolidays();
+    void setBusinessDay(int index, bool business_day);
+    void updateCounts();
+    int bitIndex(const Date& date) const;
+    int businessDaysBefore(int index) const;
+    int nextBusinessDay(int index) const;
+    int previousBusinessDay(int index) const;
+    Date dateFromIndex(int index) const {return dateFromDayNumber(index + first_day_);}
+    std::string name_;
+    int first_day_;
+    int day_count_;
+    std::vector<uint64_t> business_days_;
+    std::vector<int> counts_before_word_;
+};
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define CASHFLOW_HPP
 
 #include <cstdint>
+#include <vector>
+#include <memory_resource>
 
 #include "date.hpp"
 
@@ -16,6 +18,7 @@ struct CashFlow {
         return rhs.due_date < due_date;
     }
 };   
+using CashFlows = std::pmr::vector<CashFlow>;
 }
 
 #endif
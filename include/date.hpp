@@ -5,6 +5,9 @@
 #include <chrono>
 #include <string_view>
 #include <ctime>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
 
 namespace BondLibrary {
 enum class DayCountConvention {
@@ -15,7 +18,25 @@ enum class DayCountConvention {
     YearActualMonthActual
 };
 
+inline bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+inline int daysInMonth(int month, int year) {
+    constexpr int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (month == 2 && isLeapYear(year)) ? 29 : days[month - 1];
+}
+
 struct Date {
+    Date(int day, int month, int year)
+        : day(day), month(month), year(year) {
+        if (year < 1)
+            throw std::runtime_error("Date object constructed with bad year number");
+        if (month < 1 || month > 12)
+            throw std::runtime_error("Date object constructed with bad month number");
+        if (day < 1 || day > daysInMonth(month, year))
+            throw std::runtime_error("Date object constructed with bad day number");
+    }
     Date(const std::string& date_str) {
         if (date_str.empty())
             throw std::runtime_error("Cannot construct date object from empty string");
@@ -87,7 +108,7 @@ inline int dayNumberFromDate(int day, int month, int year) {
 }
 
 inline Date dateFromDayNumber(int num_days) {
-    int years = (10000* num_days + 14780) / 3652425;
+    int years = static_cast<int>((10000LL * num_days + 14780) / 3652425);
     int ddd = num_days - (365 * years + years / 4 - years / 100 + years / 400);
     if (ddd < 0) {
         years = years - 1;
@@ -97,7 +118,32 @@ inline Date dateFromDayNumber(int num_days) {
     int mm = (mi + 2) % 12 + 1;
     years = years + (mi + 2) / 12;
     int dd = ddd - (mi * 306 + 5) / 10 + 1;
-    return Date(std::to_string(dd) + "/" + std::to_string(mm) + "/" + std::to_string(years));
+    return Date(dd, mm, years);
+}
+
+// 0 = Monday ... 6 = Sunday
+inline int dayOfWeek(int day_number) {
+    return (day_number + 2) % 7;
+}
+
+inline int dayOfWeek(const Date& date) {
+    return dayOfWeek(dayNumberFromDate(date.day, date.month, date.year));
+}
+
+inline bool isEndOfMonth(const Date& date) {
+    return date.day == daysInMonth(date.month, date.year);
+}
+
+// Shifts a date by a number of calendar months, clamping the day to the end of the
+// target month. With end_of_month set, month-end dates stay on month-ends.
+inline Date addMonths(const Date& date, int months, bool end_of_month = false) {
+    const int month_index = date.year * 12 + (date.month - 1) + months;
+    const int year = month_index / 12;
+    const int month = month_index % 12 + 1;
+    const int last_day = daysInMonth(month, year);
+    if (end_of_month && isEndOfMonth(date))
+        return Date(last_day, month, year);
+    return Date(std::min(date.day, last_day), month, year);
 }
 
 inline Date operator+(const Date date, const int value) {
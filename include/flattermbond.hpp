@@ -15,6 +15,16 @@ public:
         Date settlement_date,
         const DayCountConvention
     );
+    FlatTermBond(
+        double face_value,
+        double coupon,
+        const Date maturity_date,
+        const Date issue_date,
+        const ScheduleRules& schedule,
+        Date settlement_date,
+        const DayCountConvention,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+    );
     double cleanPrice(const double rate, const Date date) const;
     double dirtyPrice(const double rate, const Date date) const;
     double dirtyPriceFromCleanPrice(const double market_price, const Date date) const;
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <cmath>
+#include <span>
 
 #include "basebond.hpp"
 #include "yieldcurve.hpp"
@@ -20,6 +21,17 @@ public:
         YieldCurve& yield_curve,
         const DayCountConvention
     );
+    GeneralTermBond(
+        double face_value,
+        double coupon,
+        const Date maturity_date,
+        const Date issue_date,
+        const ScheduleRules& schedule,
+        const Date settlement_date,
+        YieldCurve& yield_curve,
+        const DayCountConvention,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+    );
     double cleanPrice(const Date date) const;
     double dirtyPrice(const Date date) const;
     //double dirtyPrice(const double market_price, const Date date) const;
@@ -27,12 +39,24 @@ public:
     double duration(const double rate, const Date date) const override;
     void setYieldCurve(YieldCurve& yc) const {yield_curve_ = yc;}
     YieldCurve& getYieldCurve() const {return yield_curve_;}
+    // Curve pricing over raw cashflow and curve storage, shared with callers that do
+    // not hold GeneralTermBond objects (e.g. the shared memory store)
+    static double presentValueOnCurve(
+        std::span<const CashFlow> cashflows,
+        std::span<const YieldCurvePoint> yield_curve,
+        const Date& date
+    );
+    static double durationOnCurve(
+        std::span<const CashFlow> cashflows,
+        std::span<const YieldCurvePoint> yield_curve,
+        const Date& date
+    );
 private:
-    int yearsAccrued(const Date& date) const;
-    double getYearFraction(const Date& date) const;
-    double discountFactorFromYield(const double rate, const double time) const;
+    static int yearsAccrued(const Date& date, const Date& first_cashflow_date);
+    static double getYearFraction(const Date& date);
+    static double discountFactorFromYield(const double rate, const double time);
+    static double performLinearInterpolation(std::span<const YieldCurvePoint> yield_curve, const double time);
     double valueBasedOnYieldCurve(const double rate, Date date) const;
-    double performLinearInterpolation(const double time) const;
     YieldCurve& yield_curve_;
 };
 }
@@ -0,0 +1,60 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "date.hpp"
+#include "generaltermbond.hpp"
+#include "yieldcurve.hpp"
+
+namespace BondLibrary {
+struct ReplayStats {
+    size_t ticks = 0;
+    size_t prices = 0;
+    double elapsed_seconds = 0.0;
+    double ticks_per_second = 0.0;
+    // tick-to-price latencies in microseconds, measured from the tick's release time
+    // until every price it triggered has been written
+    double latency_p50 = 0.0;
+    double latency_p90 = 0.0;
+    double latency_p99 = 0.0;
+    double latency_p999 = 0.0;
+    double latency_max = 0.0;
+};
+
+// Replays a recorded market data file through registered curves and bonds. Each line is
+//     timestamp_ns,CURVE,curve_id,maturity,yield
+//     timestamp_ns,QUOTE,bond_id,clean_price
+// A curve tick sets that point on the curve and reprices every bond priced off it, a quote
+// tick solves the bond's yield to maturity. Results are written as
+//     timestamp_ns,bond_id,PRICE|YIELD,value
+class MarketDataReplay {
+public:
+    MarketDataReplay(const Date valuation_date)
+        : valuation_date_(valuation_date)
+    {}
+    void addCurve(const std::string& curve_id, YieldCurve& curve);
+    void addBond(const std::string& bond_id, GeneralTermBond& bond);
+    ReplayStats run(const std::string& input_path, const std::string& output_path, bool recorded_speed) const;
+private:
+    struct Tick {
+        int64_t timestamp;
+        bool curve_update;
+        size_t target;
+        double first;
+        double second;
+    };
+    std::vector<Tick> loadTicks(const std::string& input_path) const;
+    Date valuation_date_;
+    std::vector<YieldCurve*> curves_;
+    std::vector<std::string> bond_ids_;
+    std::vector<GeneralTermBond*> bonds_;
+    std::unordered_map<std::string, size_t> curve_index_;
+    std::unordered_map<std::string, size_t> bond_index_;
+};
+}
+
+#endif
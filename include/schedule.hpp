@@ -0,0 +1,55 @@
+#ifndef SCHEDULE_HPP
+#define SCHEDULE_HPP
+
+#include <vector>
+
+#include "calendar.hpp"
+#include "cashflow.hpp"
+#include "date.hpp"
+
+namespace BondLibrary {
+enum class Frequency {
+    Annual = 1,
+    SemiAnnual = 2,
+    Quarterly = 4,
+    Monthly = 12
+};
+
+enum class StubRule {
+    ShortFront, // roll back from maturity, odd period at the start
+    LongFront,  // roll back from maturity, odd period merged into the first coupon
+    ShortBack,  // roll forward from issue, odd period at the end
+    LongBack    // roll forward from issue, odd period merged into the last coupon
+};
+
+struct ScheduleRules {
+    ScheduleRules(Frequency frequency, StubRule stub_rule, bool end_of_month)
+        : frequency(frequency), stub_rule(stub_rule), end_of_month(end_of_month)
+    {}
+    ScheduleRules(Frequency frequency, StubRule stub_rule, bool end_of_month,
+     const Calendar& calendar, BusinessDayConvention convention)
+        : frequency(frequency), stub_rule(stub_rule), end_of_month(end_of_month)
+        , calendar(&calendar), convention(convention)
+    {}
+    Frequency frequency = Frequency::Annual;
+    StubRule stub_rule = StubRule::ShortFront;
+    bool end_of_month = false; // month-end anchors keep paying on month-ends
+    const Calendar* calendar = nullptr; // payment dates are rolled on this calendar if set
+    BusinessDayConvention convention = BusinessDayConvention::Unadjusted;
+};
+
+// Appends the coupon schedule of a bond to cashflows in due date order. Regular
+// coupons pay coupon / frequency, stub coupons are pro-rated by actual days against
+// the neighbouring regular period and the final coupon includes the face value.
+// Amounts are worked out on the unadjusted dates before any business day roll.
+void generateSchedule(
+    CashFlows& cashflows,
+    double face_value,
+    double coupon,
+    const Date& issue_date,
+    const Date& maturity_date,
+    const ScheduleRules& rules
+);
+}
+
+#endif
@@ -42,6 +42,15 @@ public:
             PyErr_Print();
         }
     }
+    void setPoint(double maturity, double yield) {
+        // Keeps the curve in increasing maturity order, replacing the yield of an existing tenor
+        auto it = std::lower_bound(yield_curve_.begin(), yield_curve_.end(), maturity,
+            [](const YieldCurvePoint& pt, double value) { return pt.maturity < value; });
+        if (it != yield_curve_.end() && it->maturity == maturity)
+            it->yield = yield;
+        else
+            yield_curve_.insert(it, YieldCurvePoint(maturity, yield));
+    }
     const std::vector<YieldCurvePoint>& getYieldCurve() const {return yield_curve_;}
 private:
     void addToCurve(boost::python::list& curve_points) {
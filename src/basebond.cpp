@@ -33,6 +33,28 @@ BaseBond::BaseBond(double face_value, double coupon, const Date maturity_date,
     if (nflows >= 2 && cashflows_[nflows -1].cashflow == cashflows_[nflows - 2].cashflow) {
         cashflows_[nflows - 1].cashflow += face_value;
     }
+    checkSchedule();
+}
+
+BaseBond::BaseBond(double face_value, double coupon, const Date maturity_date,
+ const Date issue_date, const ScheduleRules& schedule, const Date settlement_date,
+ const DayCountConvention daycount_convention, std::pmr::memory_resource* resource)
+  : face_value_(face_value)
+  , coupon_(coupon)
+  , maturity_date_(maturity_date)
+  , issue_date_(issue_date)
+  , settlement_date_(settlement_date)
+  , cashflows_(resource)
+  , daycount_convention_(daycount_convention) {
+    if (maturity_date_ < issue_date_)
+        throw std::runtime_error("Maturity date must be later than issue date");
+    generateSchedule(cashflows_, face_value, coupon, issue_date, maturity_date, schedule);
+    checkSchedule();
+}
+
+void BaseBond::checkSchedule() const {
+    if (cashflows_.empty())
+        throw std::runtime_error("Tried to construct bond without cashflows");
     if (cashflows_[0].due_date < issue_date_)
         throw std::runtime_error("Issue date must be earlier than first payment date");
     else if (maturity_date_ < issue_date_)
@@ -165,9 +187,11 @@ double BaseBond::getCurrentYield(double market_price) const {
 }
 
 bool BaseBond::isExpired() const {
-    if (cashflows_.back().due_date < getCurrentDate())
-        return true;
-    return false;
+    return isExpired(getCurrentDate());
+}
+
+bool BaseBond::isExpired(const Date& date) const {
+    return cashflows_.back().due_date < date;
 }
 
 CashFlowOpt BaseBond::getCashFlow(Date date) const {
@@ -0,0 +1,87 @@
+#include "bondbatch.hpp"
+#include <memory>
+#include <stdexcept>
+
+using namespace BondLibrary;
+
+BondBatch::BondBatch(size_t expected_bonds, size_t expected_cashflows)
+  : expected_bonds_(expected_bonds)
+  , arena_(expected_bonds * (sizeof(GeneralTermBond) + sizeof(GeneralTermBond*) + sizeof(double))
+        + expected_cashflows * sizeof(CashFlow) + 1)
+  , bonds_(&arena_)
+  , results_(&arena_) {
+    reserve();
+}
+
+BondBatch::~BondBatch() {
+    for (auto* bond : bonds_)
+        std::destroy_at(bond);
+}
+
+size_t BondBatch::addBond(double face_value, double coupon, const Date maturity_date,
+ const Date issue_date, const ScheduleRules& schedule, const Date settlement_date,
+ YieldCurve& yield_curve, const DayCountConvention daycount_convention) {
+    std::pmr::polymorphic_allocator<> allocator(&arena_);
+    bonds_.push_back(allocator.new_object<GeneralTermBond>(face_value, coupon, maturity_date,
+        issue_date, schedule, settlement_date, yield_curve, daycount_convention, &arena_));
+    return bonds_.size() - 1;
+}
+
+GeneralTermBond& BondBatch::getBond(size_t index) const {
+    if (index >= bonds_.size())
+        throw std::out_of_range("Bond index is beyond the end of the batch");
+    return *bonds_[index];
+}
+
+GeneralTermBond& BondBatch::getBond(size_t index, size_t generation) const {
+    if (generation != generation_)
+        throw std::runtime_error("Bond handle was taken from the batch before it was released");
+    return getBond(index);
+}
+
+std::span<const double> BondBatch::cleanPrices(const Date date) {
+    const auto prices = resultBuffer();
+    cleanPrices(date, prices);
+    return prices;
+}
+
+void BondBatch::cleanPrices(const Date date, std::span<double> prices) const {
+    if (prices.size() < bonds_.size())
+        throw std::runtime_error("Result buffer is smaller than the bond batch");
+    for (size_t i = 0; i < bonds_.size(); ++i)
+        prices[i] = bonds_[i]->cleanPrice(date);
+}
+
+std::span<const double> BondBatch::durations(const Date date) {
+    const auto results = resultBuffer();
+    durations(date, results);
+    return results;
+}
+
+void BondBatch::durations(const Date date, std::span<double> durations) const {
+    if (durations.size() < bonds_.size())
+        throw std::runtime_error("Result buffer is smaller than the bond batch");
+    for (size_t i = 0; i < bonds_.size(); ++i)
+        durations[i] = bonds_[i]->getDuration(date);
+}
+
+void BondBatch::release() {
+    for (auto* bond : bonds_)
+        std::destroy_at(bond);
+    // Drop the vectors' hold on arena memory before the arena hands it all back
+    std::pmr::vector<GeneralTermBond*>(&arena_).swap(bonds_);
+    std::pmr::vector<double>(&arena_).swap(results_);
+    arena_.release();
+    ++generation_;
+    reserve();
+}
+
+void BondBatch::reserve() {
+    bonds_.reserve(expected_bonds_);
+    results_.reserve(expected_bonds_);
+}
+
+std::span<double> BondBatch::resultBuffer() {
+    results_.resize(bonds_.size());
+    return results_;
+}
@@ -0,0 +1,277 @@
+#include "bondstore.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace BondLibrary;
+
+namespace {
+constexpr uint64_t store_magic = 0x524f5453444e4f42; // "BONDSTOR"
+// A rewrite is a few hundred stores; a curve left odd for this long means the loader died
+// mid-publish and the curve will never become consistent again
+constexpr auto curve_rewrite_timeout = std::chrono::seconds(1);
+
+std::string shmName(const std::string& name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+void copyId(char* dst, const std::string& id) {
+    if (id.empty() || id.size() > BondStore::max_id_length_)
+        throw std::runtime_error("Bond store ids must be between 1 and "
+            + std::to_string(BondStore::max_id_length_) + " characters: " + id);
+    std::memset(dst, 0, BondStore::max_id_length_ + 1);
+    std::memcpy(dst, id.data(), id.size());
+}
+}
+
+BondStore::BondStore(const std::string& name)
+  : name_(shmName(name)) {
+    fd_ = shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd_ < 0)
+        throw std::runtime_error("Could not attach to bond store " + name_ + ": " + std::strerror(errno));
+    struct stat info;
+    if (fstat(fd_, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+        release();
+        throw std::runtime_error("Shared memory object " + name_ + " is not a bond store");
+    }
+    map(info.st_size, false);
+    if (std::atomic_ref<uint64_t>(header_->magic).load(std::memory_order_acquire) != store_magic
+     || header_->size != static_cast<uint64_t>(info.st_size)) {
+        release();
+        throw std::runtime_error("Shared memory object " + name_ + " is not an initialised bond store");
+    }
+    curve_snapshot_.reserve(max_curve_points_);
+}
+
+BondStore::BondStore(const std::string& name, size_t max_curves, size_t max_bonds, size_t max_cashflows)
+  : name_(shmName(name)) {
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd_ < 0)
+        throw std::runtime_error("Could not create bond store " + name_ + ": " + std::strerror(errno));
+    const size_t size = storeSize(max_curves, max_bonds, max_cashflows);
+    if (ftruncate(fd_, size) != 0) {
+        const std::string error = std::strerror(errno);
+        release();
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("Could not size bond store " + name_ + ": " + error);
+    }
+    map(size, true);
+    header_->size = size;
+    header_->max_curves = max_curves;
+    header_->max_bonds = max_bonds;
+    header_->max_cashflows = max_cashflows;
+    std::atomic_ref<uint64_t>(header_->magic).store(store_magic, std::memory_order_release);
+    curve_snapshot_.reserve(max_curve_points_);
+}
+
+BondStore::~BondStore() {
+    release();
+}
+
+void BondStore::remove(const std::string& name) {
+    if (shm_unlink(shmName(name).c_str()) != 0 && errno != ENOENT)
+        throw std::runtime_error("Could not remove bond store " + name + ": " + std::strerror(errno));
+}
+
+void BondStore::map(size_t size, bool writable) {
+    void* base = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+    if (base == MAP_FAILED) {
+        const std::string error = std::strerror(errno);
+        release();
+        throw std::runtime_error("Could not map bond store " + name_ + ": " + error);
+    }
+    base_ = static_cast<unsigned char*>(base);
+    mapped_size_ = size;
+    header_ = reinterpret_cast<Header*>(base_);
+    writable_ = writable;
+}
+
+void BondStore::release() {
+    if (base_)
+        munmap(base_, mapped_size_);
+    if (fd_ >= 0)
+        close(fd_);
+    base_ = nullptr;
+    header_ = nullptr;
+    fd_ = -1;
+}
+
+size_t BondStore::storeSize(size_t max_curves, size_t max_bonds, size_t max_cashflows) {
+    return sizeof(Header) + max_curves * (sizeof(CurveRecord) + max_curve_points_ * sizeof(YieldCurvePoint))
+        + max_bonds * sizeof(BondRecord) + max_cashflows * sizeof(CashFlow);
+}
+
+void BondStore::checkWritable() const {
+    if (!writable_)
+        throw std::runtime_error("Bond store " + name_ + " is attached read-only");
+}
+
+void BondStore::publishCurve(const std::string& curve_id, const YieldCurve& curve) {
+    checkWritable();
+    const auto& points = curve.getYieldCurve();
+    if (points.size() > max_curve_points_)
+        throw std::runtime_error("Curve " + curve_id + " has more points than the bond store can hold");
+    const size_t count = curveCount();
+    const size_t index = findCurve(curve_id);
+    if (index == count) {
+        if (count == header_->max_curves)
+            throw std::runtime_error("Bond store " + name_ + " is full of curves");
+        copyId(curveRecords()[index].id, curve_id);
+    }
+    CurveRecord& record = curveRecords()[index];
+    std::atomic_ref<uint64_t> sequence(record.sequence);
+    const uint64_t before = sequence.load(std::memory_order_relaxed);
+    sequence.store(before + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    YieldCurvePoint* dst = curvePoints(index);
+    for (size_t i = 0; i < points.size(); ++i) {
+        std::atomic_ref<double>(dst[i].maturity).store(points[i].maturity, std::memory_order_relaxed);
+        std::atomic_ref<double>(dst[i].yield).store(points[i].yield, std::memory_order_relaxed);
+    }
+    std::atomic_ref<uint64_t>(record.point_count).store(points.size(), std::memory_order_relaxed);
+    sequence.store(before + 2, std::memory_order_release);
+    if (index == count)
+        std::atomic_ref<uint64_t>(header_->curve_count).store(count + 1, std::memory_order_release);
+}
+
+void BondStore::publishBond(const std::string& bond_id, const GeneralTermBond& bond, const std::string& curve_id) {
+    checkWritable();
+    const size_t curve = findCurve(curve_id);
+    if (curve == curveCount())
+        throw std::runtime_error("Curve " + curve_id + " must be published before bonds priced off it");
+    // Checked against the points workers will actually read rather than the curve object's
+    // address, which a freed curve can hand on to an unrelated one
+    const auto& own = bond.getYieldCurve().getYieldCurve();
+    const auto stored = snapshotCurve(curve);
+    if (!std::equal(own.begin(), own.end(), stored.begin(), stored.end(),
+        [](const YieldCurvePoint& a, const YieldCurvePoint& b) { return a.maturity == b.maturity && a.yield == b.yield; }))
+        throw std::runtime_error("Bond " + bond_id + " is not priced off the yield curve published as " + curve_id);
+    if (lookupBond(bond_id))
+        throw std::runtime_error("Bond " + bond_id + " is already published");
+    const auto& flows = bond.getCashFlows();
+    const size_t bonds = bondCount();
+    const size_t first_cashflow = header_->cashflow_count;
+    if (bonds == header_->max_bonds || first_cashflow + flows.size() > header_->max_cashflows)
+        throw std::runtime_error("Bond store " + name_ + " is full");
+    std::uninitialized_copy(flows.begin(), flows.end(), cashflowStore() + first_cashflow);
+    BondRecord& record = bondRecords()[bonds];
+    copyId(record.id, bond_id);
+    record.curve = curve;
+    record.first_cashflow = first_cashflow;
+    record.cashflow_count = flows.size();
+    header_->cashflow_count = first_cashflow + flows.size();
+    std::atomic_ref<uint64_t>(header_->bond_count).store(bonds + 1, std::memory_order_release);
+}
+
+double BondStore::cleanPrice(const std::string& bond_id, const Date date) const {
+    const BondRecord& bond = findBond(bond_id);
+    const auto flows = cashflows(bond);
+    if (flows.empty() || flows.back().due_date < getCurrentDate()) return 0.0;
+    return GeneralTermBond::presentValueOnCurve(flows, snapshotCurve(bond.curve), date);
+}
+
+double BondStore::getDuration(const std::string& bond_id, const Date date) const {
+    const BondRecord& bond = findBond(bond_id);
+    return round(GeneralTermBond::durationOnCurve(cashflows(bond), snapshotCurve(bond.curve), date) * 100.0) / 100.0;
+}
+
+size_t BondStore::curveCount() const {
+    return std::atomic_ref<uint64_t>(header_->curve_count).load(std::memory_order_acquire);
+}
+
+size_t BondStore::bondCount() const {
+    return std::atomic_ref<uint64_t>(header_->bond_count).load(std::memory_order_acquire);
+}
+
+size_t BondStore::findCurve(const std::string& curve_id) const {
+    const size_t count = curveCount();
+    for (size_t i = 0; i < count; ++i) {
+        if (curve_id == curveRecords()[i].id)
+            return i;
+    }
+    return count;
+}
+
+const BondStore::BondRecord* BondStore::lookupBond(const std::string& bond_id) const {
+    auto it = bond_index_.find(bond_id);
+    if (it == bond_index_.end()) {
+        // Pick up bonds the loader has published since the last lookup
+        for (const size_t count = bondCount(); indexed_bonds_ < count; ++indexed_bonds_)
+            bond_index_.emplace(bondRecords()[indexed_bonds_].id, indexed_bonds_);
+        it = bond_index_.find(bond_id);
+        if (it == bond_index_.end())
+            return nullptr;
+    }
+    return &bondRecords()[it->second];
+}
+
+const BondStore::BondRecord& BondStore::findBond(const std::string& bond_id) const {
+    const BondRecord* bond = lookupBond(bond_id);
+    if (!bond)
+        throw std::runtime_error("Bond " + bond_id + " is not in bond store " + name_);
+    return *bond;
+}
+
+std::span<const YieldCurvePoint> BondStore::snapshotCurve(size_t curve) const {
+    CurveRecord& record = curveRecords()[curve];
+    std::atomic_ref<uint64_t> sequence(record.sequence);
+    YieldCurvePoint* src = curvePoints(curve);
+    std::chrono::steady_clock::time_point deadline;
+    for (size_t attempt = 0;; ++attempt) {
+        if (attempt == 1) {
+            deadline = std::chrono::steady_clock::now() + curve_rewrite_timeout;
+        }
+        else if (attempt > 1) {
+            if (std::chrono::steady_clock::now() > deadline)
+                throw std::runtime_error("Curve " + std::string(record.id) + " in bond store " + name_
+                    + " is still being rewritten, the loader may have died mid-publish");
+            std::this_thread::yield();
+        }
+        const uint64_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        const size_t count = std::min<size_t>(
+            std::atomic_ref<uint64_t>(record.point_count).load(std::memory_order_relaxed), max_curve_points_);
+        curve_snapshot_.clear();
+        for (size_t i = 0; i < count; ++i) {
+            curve_snapshot_.emplace_back(
+                std::atomic_ref<double>(src[i].maturity).load(std::memory_order_relaxed),
+                std::atomic_ref<double>(src[i].yield).load(std::memory_order_relaxed)
+            );
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+            return curve_snapshot_;
+    }
+}
+
+std::span<const CashFlow> BondStore::cashflows(const BondRecord& bond) const {
+    return {cashflowStore() + bond.first_cashflow, bond.cashflow_count};
+}
+
+BondStore::CurveRecord* BondStore::curveRecords() const {
+    return reinterpret_cast<CurveRecord*>(base_ + sizeof(Header));
+}
+
+YieldCurvePoint* BondStore::curvePoints(size_t curve) const {
+    return reinterpret_cast<YieldCurvePoint*>(base_ + sizeof(Header) + header_->max_curves * sizeof(CurveRecord))
+        + curve * max_curve_points_;
+}
+
+BondStore::BondRecord* BondStore::bondRecords() const {
+    return reinterpret_cast<BondRecord*>(base_ + sizeof(Header)
+        + header_->max_curves * (sizeof(CurveRecord) + max_curve_points_ * sizeof(YieldCurvePoint)));
+}
+
+CashFlow* BondStore::cashflowStore() const {
+    return reinterpret_cast<CashFlow*>(reinterpret_cast<unsigned char*>(bondRecords())
+        + header_->max_bonds * sizeof(BondRecord));
+}
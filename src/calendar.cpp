@@ -0,0 +1,283 @@
+#include "calendar.hpp"
+#include <bit>
+#include <fstream>
+#include <stdexcept>
+
+using namespace BondLibrary;
+
+namespace {
+constexpr int Monday = 0, Thursday = 3, Friday = 4, Saturday = 5, Sunday = 6;
+
+Date nthWeekday(int n, int weekday, int month, int year) {
+    const int first = dayOfWeek(Date(1, month, year));
+    return Date(1 + (weekday - first + 7) % 7 + 7 * (n - 1), month, year);
+}
+
+Date lastWeekday(int weekday, int month, int year) {
+    const int last_day = daysInMonth(month, year);
+    const int last = dayOfWeek(Date(last_day, month, year));
+    return Date(last_day - (last - weekday + 7) % 7, month, year);
+}
+
+Date easterSunday(int year) {
+    const int a = year % 19, b = year / 100, c = year % 100;
+    const int d = b / 4, e = b % 4, f = (b + 8) / 25, g = (b - f + 1) / 3;
+    const int h = (19 * a + b - d - g + 15) % 30;
+    const int i = c / 4, k = c % 4;
+    const int l = (32 + 2 * e + 2 * i - h - k) % 7;
+    const int m = (a + 11 * h + 22 * l) / 451;
+    return Date((h + l - 7 * m + 114) % 31 + 1, (h + l - 7 * m + 114) / 31, year);
+}
+
+// US federal rule: Saturday holidays are observed on the Friday, Sunday ones on the Monday
+Date observed(const Date& date) {
+    const int weekday = dayOfWeek(date);
+    if (weekday == Saturday) return date + -1;
+    if (weekday == Sunday) return date + 1;
+    return date;
+}
+
+void ukHolidays(int year, std::vector<Date>& holidays) {
+    const Date new_year(1, 1, year);
+    const int new_year_weekday = dayOfWeek(new_year);
+    holidays.push_back(new_year_weekday == Saturday ? new_year + 2
+        : new_year_weekday == Sunday ? new_year + 1 : new_year);
+    const Date easter = easterSunday(year);
+    holidays.push_back(easter + -2);
+    holidays.push_back(easter + 1);
+    if (year == 1995 || year == 2020)
+        holidays.push_back(Date(8, 5, year));
+    else if (year >= 1978)
+        holidays.push_back(nthWeekday(1, Monday, 5, year));
+    if (year == 2002 || year == 2012)
+        holidays.push_back(Date(4, 6, year));
+    else if (year == 2022)
+        holidays.push_back(Date(2, 6, year));
+    else
+        holidays.push_back(lastWeekday(Monday, 5, year));
+    holidays.push_back(lastWeekday(Monday, 8, year));
+    const int christmas_weekday = dayOfWeek(Date(25, 12, year));
+    const bool christmas_on_weekend = christmas_weekday == Saturday || christmas_weekday == Sunday;
+    holidays.push_back(Date(christmas_on_weekend ? 27 : 25, 12, year));
+    holidays.push_back(Date(christmas_weekday == Friday || christmas_weekday == Saturday ? 28 : 26, 12, year));
+    for (const Date& special : {Date(31, 12, 1999), Date(3, 6, 2002), Date(29, 4, 2011), Date(5, 6, 2012),
+     Date(3, 6, 2022), Date(19, 9, 2022), Date(8, 5, 2023)}) {
+        if (special.year == year)
+            holidays.push_back(special);
+    }
+}
+
+void usHolidays(int year, std::vector<Date>& holidays) {
+    const Date new_year(1, 1, year);
+    if (dayOfWeek(new_year) == Sunday)
+        holidays.push_back(new_year + 1);
+    else if (dayOfWeek(new_year) != Saturday)
+        holidays.push_back(new_year);
+    if (dayOfWeek(Date(1, 1, year + 1)) == Saturday)
+        holidays.push_back(Date(31, 12, year));
+    if (year >= 1983)
+        holidays.push_back(nthWeekday(3, Monday, 1, year));
+    holidays.push_back(nthWeekday(3, Monday, 2, year));
+    holidays.push_back(lastWeekday(Monday, 5, year));
+    if (year >= 2022)
+        holidays.push_back(observed(Date(19, 6, year)));
+    holidays.push_back(observed(Date(4, 7, year)));
+    holidays.push_back(nthWeekday(1, Monday, 9, year));
+    holidays.push_back(nthWeekday(2, Monday, 10, year));
+    holidays.push_back(observed(Date(11, 11, year)));
+    holidays.push_back(nthWeekday(4, Thursday, 11, year));
+    holidays.push_back(observed(Date(25, 12, year)));
+}
+
+void targetHolidays(int year, std::vector<Date>& holidays) {
+    holidays.push_back(Date(1, 1, year));
+    holidays.push_back(Date(25, 12, year));
+    if (year >= 2000) {
+        const Date easter = easterSunday(year);
+        holidays.push_back(easter + -2);
+        holidays.push_back(easter + 1);
+        holidays.push_back(Date(1, 5, year));
+        holidays.push_back(Date(26, 12, year));
+    }
+    if (year == 1998 || year == 1999 || year == 2001)
+        holidays.push_back(Date(31, 12, year));
+}
+}
+
+Calendar::Calendar(const std::string& name)
+  : name_(name) {
+    addWeekendsOnly();
+    addBuiltInHolidays();
+    updateCounts();
+}
+
+Calendar::Calendar(const std::string& name, const boost::python::list& holidays)
+  : name_(name) {
+    addWeekendsOnly();
+    try {
+        const boost::python::ssize_t len = boost::python::len(holidays);
+        for (auto i = 0; i < len; ++i) {
+            auto element = boost::python::extract<Date>(holidays[i]);
+            if (element.check()) {
+                setBusinessDay(bitIndex(element), false);
+            }
+            else {
+                throw std::runtime_error("Tried to construct a Calendar with holidays that are not Dates");
+            }
+        }
+    }
+    catch (const boost::python::error_already_set&) {
+        PyErr_Print();
+    }
+    updateCounts();
+}
+
+void Calendar::addWeekendsOnly() {
+    first_day_ = dayNumberFromDate(1, 1, first_year_);
+    day_count_ = dayNumberFromDate(1, 1, last_year_ + 1) - first_day_;
+    business_days_.assign(day_count_ / 64 + 1, 0);
+    for (int i = 0; i < day_count_; ++i) {
+        if (dayOfWeek(first_day_ + i) < Saturday)
+            setBusinessDay(i, true);
+    }
+}
+
+void Calendar::addBuiltInHolidays() {
+    void (*rule)(int, std::vector<Date>&) = nullptr;
+    if (name_ == "UK")
+        rule = ukHolidays;
+    else if (name_ == "US")
+        rule = usHolidays;
+    else if (name_ == "TARGET")
+        rule = targetHolidays;
+    else
+        throw std::runtime_error("Unknown calendar '" + name_ + "', built in calendars are UK, US and TARGET");
+    std::vector<Date> holidays;
+    for (int year = first_year_; year <= last_year_; ++year) {
+        holidays.clear();
+        rule(year, holidays);
+        for (const auto& holiday : holidays)
+            setBusinessDay(bitIndex(holiday), false);
+    }
+}
+
+void Calendar::addHoliday(const Date& date) {
+    setBusinessDay(bitIndex(date), false);
+    updateCounts();
+}
+
+void Calendar::removeHoliday(const Date& date) {
+    const int index = bitIndex(date);
+    setBusinessDay(index, dayOfWeek(first_day_ + index) < Saturday);
+    updateCounts();
+}
+
+void Calendar::loadHolidays(const std::string& path) {
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error("Could not open holiday file " + path);
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+        setBusinessDay(bitIndex(Date(line)), false);
+    }
+    updateCounts();
+}
+
+bool Calendar::isBusinessDay(const Date& date) const {
+    const int index = bitIndex(date);
+    return (business_days_[index >> 6] >> (index & 63)) & 1;
+}
+
+int Calendar::businessDaysBetween(const Date& from, const Date& to) const {
+    return businessDaysBefore(bitIndex(to)) - businessDaysBefore(bitIndex(from));
+}
+
+Date Calendar::adjust(const Date& date, const BusinessDayConvention convention) const {
+    using BDC = BusinessDayConvention;
+    const int index = bitIndex(date);
+    switch (convention) {
+        case BDC::Following:
+            return dateFromIndex(nextBusinessDay(index));
+        case BDC::ModifiedFollowing: {
+            const Date following = dateFromIndex(nextBusinessDay(index));
+            return following.month == date.month ? following : dateFromIndex(previousBusinessDay(index));
+        }
+        case BDC::Preceding:
+            return dateFromIndex(previousBusinessDay(index));
+        case BDC::ModifiedPreceding: {
+            const Date preceding = dateFromIndex(previousBusinessDay(index));
+            return preceding.month == date.month ? preceding : dateFromIndex(nextBusinessDay(index));
+        }
+        default:
+            return date;
+    }
+}
+
+Date Calendar::advance(const Date& date, int business_days) const {
+    int index = bitIndex(date);
+    if (business_days == 0)
+        return dateFromIndex(nextBusinessDay(index));
+    for (; business_days > 0; --business_days)
+        index = nextBusinessDay(index + 1);
+    for (; business_days < 0; ++business_days)
+        index = previousBusinessDay(index - 1);
+    return dateFromIndex(index);
+}
+
+void Calendar::setBusinessDay(int index, bool business_day) {
+    const uint64_t bit = uint64_t{1} << (index & 63);
+    if (business_day)
+        business_days_[index >> 6] |= bit;
+    else
+        business_days_[index >> 6] &= ~bit;
+}
+
+void Calendar::updateCounts() {
+    counts_before_word_.resize(business_days_.size());
+    int count = 0;
+    for (size_t i = 0; i < business_days_.size(); ++i) {
+        counts_before_word_[i] = count;
+        count += std::popcount(business_days_[i]);
+    }
+}
+
+int Calendar::bitIndex(const Date& date) const {
+    const int index = dayNumberFromDate(date.day, date.month, date.year) - first_day_;
+    if (index < 0 || index >= day_count_)
+        throw std::runtime_error("Date is outside of the calendar range");
+    return index;
+}
+
+int Calendar::businessDaysBefore(int index) const {
+    const uint64_t below = (uint64_t{1} << (index & 63)) - 1;
+    return counts_before_word_[index >> 6] + std::popcount(business_days_[index >> 6] & below);
+}
+
+int Calendar::nextBusinessDay(int index) const {
+    if (index >= day_count_)
+        throw std::runtime_error("Rolled past the end of the calendar range");
+    size_t word = index >> 6;
+    uint64_t bits = business_days_[word] & (~uint64_t{0} << (index & 63));
+    while (bits == 0) {
+        if (++word == business_days_.size())
+            throw std::runtime_error("Rolled past the end of the calendar range");
+        bits = business_days_[word];
+    }
+    return static_cast<int>(word * 64) + std::countr_zero(bits);
+}
+
+int Calendar::previousBusinessDay(int index) const {
+    if (index < 0)
+        throw std::runtime_error("Rolled past the start of the calendar range");
+    size_t word = index >> 6;
+    uint64_t bits = business_days_[word] & (~uint64_t{0} >> (63 - (index & 63)));
+    while (bits == 0) {
+        if (word-- == 0)
+            throw std::runtime_error("Rolled past the start of the calendar range");
+        bits = business_days_[word];
+    }
+    return static_cast<int>(word * 64) + 63 - std::countl_zero(bits);
+}
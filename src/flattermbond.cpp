@@ -9,6 +9,12 @@ FlatTermBond::FlatTermBond(double face_value, double coupon, const Date maturity
     : BaseBond(face_value, coupon, maturity_date, issue_date, cashflows, settlement_date, daycount_convention)
 {}
 
+FlatTermBond::FlatTermBond(double face_value, double coupon, const Date maturity_date,
+ const Date issue_date, const ScheduleRules& schedule, Date settlement_date,
+ const DayCountConvention daycount_convention, std::pmr::memory_resource* resource)
+    : BaseBond(face_value, coupon, maturity_date, issue_date, schedule, settlement_date, daycount_convention, resource)
+{}
+
 double FlatTermBond::cleanPrice(const double rate, const Date date) const {
     return notionalPresentValue(rate, date);
 }
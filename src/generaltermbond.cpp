@@ -9,6 +9,13 @@ GeneralTermBond::GeneralTermBond(double face_value, double coupon, const Date ma
   , yield_curve_(yield_curve)
 {}
 
+GeneralTermBond::GeneralTermBond(double face_value, double coupon, const Date maturity_date,
+ const Date issue_date, const ScheduleRules& schedule, const Date settlement_date,
+ YieldCurve& yield_curve, const DayCountConvention daycount_convention, std::pmr::memory_resource* resource)
+  : BaseBond(face_value, coupon, maturity_date, issue_date, schedule, settlement_date, daycount_convention, resource)
+  , yield_curve_(yield_curve)
+{}
+
 double GeneralTermBond::cleanPrice(const Date date) const {
     if (isExpired()) return 0.0;
     return valueBasedOnYieldCurve(0, date);
@@ -26,29 +33,39 @@ double GeneralTermBond::dirtyPrice(const double market_price, const Date date) c
 */
 
 double GeneralTermBond::valueBasedOnYieldCurve(const double, Date date) const {
+    return presentValueOnCurve(cashflows_, yield_curve_.getYieldCurve(), date);
+}
+
+double GeneralTermBond::presentValueOnCurve(std::span<const CashFlow> cashflows,
+ std::span<const YieldCurvePoint> yield_curve, const Date& date) {
     double npv = 0.0;
     size_t t = 1;
-    for (size_t i = 0; i < cashflows_.size(); ++i) {
-        if (cashflows_[i].due_date < date) continue;
-        npv += discountFactorFromYield(performLinearInterpolation(
-            getYearFraction(cashflows_[i].due_date) + yearsAccrued(cashflows_[i].due_date)
-        ), t) * cashflows_[i].cashflow;
+    for (size_t i = 0; i < cashflows.size(); ++i) {
+        if (cashflows[i].due_date < date) continue;
+        npv += discountFactorFromYield(performLinearInterpolation(yield_curve,
+            getYearFraction(cashflows[i].due_date) + yearsAccrued(cashflows[i].due_date, cashflows[0].due_date)
+        ), t) * cashflows[i].cashflow;
         ++t;
     }
     return round((npv * 100.0)) / 100.0;
 }
 
 double GeneralTermBond::duration(const double, Date date) const {
+    return durationOnCurve(cashflows_, yield_curve_.getYieldCurve(), date);
+}
+
+double GeneralTermBond::durationOnCurve(std::span<const CashFlow> cashflows,
+ std::span<const YieldCurvePoint> yield_curve, const Date& date) {
     double s = 0.0, d1 = 0.0;
     double dfactor = 0.0;
     int t = 1;
-    for (size_t i = 0; i < cashflows_.size(); ++i) {
-        if (cashflows_[i].due_date < date) continue;
-        dfactor = discountFactorFromYield(
-            performLinearInterpolation(getYearFraction(cashflows_[i].due_date) + yearsAccrued(cashflows_[i].due_date)
+    for (size_t i = 0; i < cashflows.size(); ++i) {
+        if (cashflows[i].due_date < date) continue;
+        dfactor = discountFactorFromYield(performLinearInterpolation(yield_curve,
+            getYearFraction(cashflows[i].due_date) + yearsAccrued(cashflows[i].due_date, cashflows[0].due_date)
         ), t);
-        s += cashflows_[i].cashflow * dfactor;
-        d1 += t * cashflows_[i].cashflow * dfactor;
+        s += cashflows[i].cashflow * dfactor;
+        d1 += t * cashflows[i].cashflow * dfactor;
         ++t;
     }
     return d1 / s;
@@ -58,12 +75,13 @@ double GeneralTermBond::getDuration(const Date date) const {
     return round(duration(0, date) * 100.0) / 100.0;
 }
 
-double GeneralTermBond::discountFactorFromYield(const double rate, const double time) const {
+double GeneralTermBond::discountFactorFromYield(const double rate, const double time) {
     return exp(-rate * time);
 }
 
-double GeneralTermBond::performLinearInterpolation(const double time) const {
-    const auto& yield_curve = yield_curve_.getYieldCurve(); // Yields are in increasing time to maturity order
+double GeneralTermBond::performLinearInterpolation(std::span<const YieldCurvePoint> yield_curve,
+ const double time) {
+    // Yields are in increasing time to maturity order
     if (yield_curve.size() < 1) return 0.0;
     auto t_min = yield_curve[0].maturity;
     const auto& curve_max = yield_curve[yield_curve.size() - 1];
@@ -80,13 +98,13 @@ double GeneralTermBond::performLinearInterpolation(const double time) const {
     return yield_curve[t - 1].yield * lambda + yield_curve[t].yield * (1.0 - lambda);
 }
 
-double GeneralTermBond::getYearFraction(const Date& date) const {
+double GeneralTermBond::getYearFraction(const Date& date) {
     double frac = 0.0;
     for (int i = 0; i < date.month; ++i)
         frac += BaseBond::month_days_[i];
     return (frac + static_cast<double>(date.day - 1)) / 365.0;
 }
 
-int GeneralTermBond::yearsAccrued(const Date& date) const {
-    return abs(date.year - cashflows_[0].due_date.year + 1); // year 0 counts as 'year 1'
+int GeneralTermBond::yearsAccrued(const Date& date, const Date& first_cashflow_date) {
+    return abs(date.year - first_cashflow_date.year + 1); // year 0 counts as 'year 1'
 }
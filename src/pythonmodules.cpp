@@ -3,10 +3,20 @@
 #include "flattermbond.hpp"
 #include "date.hpp"
 #include "generaltermbond.hpp"
+#include "schedule.hpp"
+#include "calendar.hpp"
+#include "replay.hpp"
+#include "bondstore.hpp"
+#include "bondbatch.hpp"
 
 using namespace boost::python;
 using Date = BondLibrary::Date;
 using DC = BondLibrary::DayCountConvention;
+using Frequency = BondLibrary::Frequency;
+using StubRule = BondLibrary::StubRule;
+using ScheduleRules = BondLibrary::ScheduleRules;
+using BDC = BondLibrary::BusinessDayConvention;
+using IsExpired = bool (BondLibrary::BaseBond::*)() const;
 
 struct BaseBondWrapper : ::BondLibrary::BaseBond, wrapper<BondLibrary::BaseBond> {
     BaseBondWrapper(const double f, const double c, const Date md, 
@@ -19,7 +29,82 @@ struct BaseBondWrapper : ::BondLibrary::BaseBond, wrapper<BondLibrary::BaseBond>
     }
 };
 
+// Writable Python buffer of doubles (array.array('d'), numpy float64) that batch results
+// are written into in place, rather than boxed one float at a time
+struct DoubleBuffer {
+    DoubleBuffer(const object& buffer) {
+        if (PyObject_GetBuffer(buffer.ptr(), &view, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0)
+            throw_error_already_set();
+        const std::string_view format = view.format ? view.format : "B";
+        if (view.itemsize != sizeof(double) || (format != "d" && format != "@d" && format != "=d")) {
+            PyBuffer_Release(&view);
+            throw std::runtime_error("Result buffer must be a writable buffer of doubles");
+        }
+    }
+    ~DoubleBuffer() {PyBuffer_Release(&view);}
+    std::span<double> values() {return {static_cast<double*>(view.buf), static_cast<size_t>(view.len) / sizeof(double)};}
+    Py_buffer view;
+};
+
+object toDoubleArray(std::span<const double> values) {
+    object result = import("array").attr("array")("d");
+    object bytes(handle<>(PyMemoryView_FromMemory(
+        reinterpret_cast<char*>(const_cast<double*>(values.data())), values.size_bytes(), PyBUF_READ
+    )));
+    result.attr("frombytes")(bytes);
+    return result;
+}
+
+// Python side of a BondBatch, which keeps each distinct curve its bonds price off alive
+// once, until release(), rather than tying every added bond to its curve separately
+struct BondBatchWrapper : BondLibrary::BondBatch {
+    BondBatchWrapper(PyObject*, size_t expected_bonds, size_t expected_cashflows)
+        : BondLibrary::BondBatch(expected_bonds, expected_cashflows)
+    {}
+    std::vector<object> curves;
+};
+
+size_t batchAddBond(BondBatchWrapper& batch, const double face_value, const double coupon,
+ const Date maturity_date, const Date issue_date, const ScheduleRules& schedule,
+ const Date settlement_date, const object& yield_curve, const DC dc_convention) {
+    const size_t index = batch.addBond(face_value, coupon, maturity_date, issue_date, schedule,
+        settlement_date, extract<BondLibrary::YieldCurve&>(yield_curve), dc_convention);
+    if (std::none_of(batch.curves.begin(), batch.curves.end(),
+        [&](const object& curve) { return curve.ptr() == yield_curve.ptr(); }))
+        batch.curves.push_back(yield_curve);
+    return index;
+}
+
+void batchRelease(BondBatchWrapper& batch) {
+    batch.release();
+    batch.curves.clear();
+}
+
+object batchCleanPrices(BondLibrary::BondBatch& batch, const Date date) {
+    return toDoubleArray(batch.cleanPrices(date));
+}
+
+void batchCleanPricesInto(BondLibrary::BondBatch& batch, const Date date, const object& prices) {
+    DoubleBuffer buffer(prices);
+    batch.cleanPrices(date, buffer.values());
+}
+
+object batchDurations(BondLibrary::BondBatch& batch, const Date date) {
+    return toDoubleArray(batch.durations(date));
+}
+
+BondLibrary::BatchBond batchGetBond(const BondLibrary::BondBatch& batch, size_t index) {
+    return BondLibrary::BatchBond(batch, index);
+}
+
+void batchDurationsInto(BondLibrary::BondBatch& batch, const Date date, const object& durations) {
+    DoubleBuffer buffer(durations);
+    batch.durations(date, buffer.values());
+}
+
 BOOST_PYTHON_MODULE(BondPricing) {
+    const BondLibrary::Calendar settlement_calendar("UK");
+    const Date default_settlement = settlement_calendar.advance(BondLibrary::getCurrentDate(), 2);
     class_<BondLibrary::YieldCurvePoint>("YieldCurvePoint", init<double, double>((arg("maturity"), arg("bond_yield"))))
         .def_readwrite("maturity", &BondLibrary::YieldCurvePoint::maturity)
         .def_readwrite("bond_yield", &BondLibrary::YieldCurvePoint::yield)
@@ -27,13 +112,53 @@ BOOST_PYTHON_MODULE(BondPricing) {
     class_<BondLibrary::YieldCurve>("YieldCurve", init<list&>())
         .def("addToYieldCurve", &BondLibrary::YieldCurve::addToYieldCurve)
         .def("removeFromYieldCurve", &BondLibrary::YieldCurve::removeFromYieldCurve);
-    class_<Date>("Date", init<const std::string&>());
+    class_<Date>("Date", init<const std::string&>())
+        .def(init<int, int, int>((arg("day"), arg("month"), arg("year"))))
+        .def_readonly("day", &Date::day)
+        .def_readonly("month", &Date::month)
+        .def_readonly("year", &Date::year)
+        .def("__eq__", &Date::operator==);
     enum_<BondLibrary::DayCountConvention>("DayCountConvention")
         .value("Year360Month30", DC::Year360Month30)
         .value("Year365Month30", DC::Year365Month30)
         .value("Year360MonthActual", DC::Year360MonthActual)
         .value("Year365MonthActual", DC::Year365MonthActual)
         .value("YearActualMonthActual", DC::YearActualMonthActual);
+    enum_<BDC>("BusinessDayConvention")
+        .value("Unadjusted", BDC::Unadjusted)
+        .value("Following", BDC::Following)
+        .value("ModifiedFollowing", BDC::ModifiedFollowing)
+        .value("Preceding", BDC::Preceding)
+        .value("ModifiedPreceding", BDC::ModifiedPreceding);
+    class_<BondLibrary::Calendar>("Calendar", init<const std::string&>(arg("name")))
+        .def(init<const std::string&, const list&>((arg("name"), arg("holidays"))))
+        .def("addHoliday", &BondLibrary::Calendar::addHoliday)
+        .def("removeHoliday", &BondLibrary::Calendar::removeHoliday)
+        .def("loadHolidays", &BondLibrary::Calendar::loadHolidays)
+        .def("isBusinessDay", &BondLibrary::Calendar::isBusinessDay)
+        .def("isHoliday", &BondLibrary::Calendar::isHoliday)
+        .def("businessDaysBetween", &BondLibrary::Calendar::businessDaysBetween)
+        .def("adjust", &BondLibrary::Calendar::adjust, (arg("date"), arg("convention")=BDC::Following))
+        .def("advance", &BondLibrary::Calendar::advance)
+        .def("getName", &BondLibrary::Calendar::getName, return_value_policy<copy_const_reference>());
+    enum_<Frequency>("Frequency")
+        .value("Annual", Frequency::Annual)
+        .value("SemiAnnual", Frequency::SemiAnnual)
+        .value("Quarterly", Frequency::Quarterly)
+        .value("Monthly", Frequency::Monthly);
+    enum_<StubRule>("StubRule")
+        .value("ShortFront", StubRule::ShortFront)
+        .value("LongFront", StubRule::LongFront)
+        .value("ShortBack", StubRule::ShortBack)
+        .value("LongBack", StubRule::LongBack);
+    class_<ScheduleRules>("ScheduleRules", init<Frequency, StubRule, bool>((
+            arg("frequency")=Frequency::Annual, arg("stub_rule")=StubRule::ShortFront,
+            arg("end_of_month")=false
+        )))
+        .def(init<Frequency, StubRule, bool, const BondLibrary::Calendar&, BDC>((
+            arg("frequency"), arg("stub_rule"), arg("end_of_month"), arg("calendar"),
+            arg("convention")=BDC::ModifiedFollowing
+        ))[with_custodian_and_ward<1, 5>()]);
     class_<BondLibrary::CashFlow>("CashFlow", init<double, Date>((arg("cashflow"), arg("due_date"))));
     class_<BaseBondWrapper, boost::noncopyable>("BaseBond", init<double, double, Date, Date, list, Date, DC>())
         .def("duration", pure_virtual(&BondLibrary::BaseBond::duration))
@@ -41,25 +166,84 @@ BOOST_PYTHON_MODULE(BondPricing) {
     class_<BondLibrary::FlatTermBond, bases<BaseBondWrapper>>(
         "FlatTermBond", init<double, double, Date, Date, list, Date, DC>((
             arg("face_value"), arg("coupon"), arg("maturity_date"), arg("issue_date"), 
-            arg("cashflows"), arg("settlement_date")=BondLibrary::getCurrentDate() + 2, 
+            arg("cashflows"), arg("settlement_date")=default_settlement, 
+            arg("dc_convention")=DC::YearActualMonthActual
+        )))
+        .def(init<double, double, Date, Date, const ScheduleRules&, Date, DC>((
+            arg("face_value"), arg("coupon"), arg("maturity_date"), arg("issue_date"),
+            arg("schedule"), arg("settlement_date")=default_settlement,
             arg("dc_convention")=DC::YearActualMonthActual
         )))
         .def("cleanPrice", &BondLibrary::FlatTermBond::cleanPrice)
         .def("dirtyPrice", &BondLibrary::FlatTermBond::dirtyPrice, (arg("rate"), arg("date")))
         .def("dirtyPriceFromCleanPrice", &BondLibrary::FlatTermBond::dirtyPriceFromCleanPrice)
         .def("duration", &BondLibrary::FlatTermBond::duration)
-        .def("isExpired", &BondLibrary::BaseBond::isExpired)
+        .def("isExpired", static_cast<IsExpired>(&BondLibrary::BaseBond::isExpired))
         .def("yieldToMaturity", &BondLibrary::BaseBond::yieldToMaturity);
     class_<BondLibrary::GeneralTermBond, bases<BaseBondWrapper>>(
         "GeneralTermBond", init<double, double, Date, Date, list&, Date, BondLibrary::YieldCurve&, DC>((
             arg("face_value"), arg("coupon"), arg("maturity_date"), arg("issue_date"),
-            arg("cashflows"), arg("settlement_date")=BondLibrary::getCurrentDate() + 2, 
+            arg("cashflows"), arg("settlement_date")=default_settlement, 
+            arg("yield_curve"), arg("dc_convention")=DC::YearActualMonthActual
+        )))
+        .def(init<double, double, Date, Date, const ScheduleRules&, Date, BondLibrary::YieldCurve&, DC>((
+            arg("face_value"), arg("coupon"), arg("maturity_date"), arg("issue_date"),
+            arg("schedule"), arg("settlement_date")=default_settlement,
             arg("yield_curve"), arg("dc_convention")=DC::YearActualMonthActual
         )))
         .def("cleanPrice", &BondLibrary::GeneralTermBond::cleanPrice)
         .def("dirtyPrice", &BondLibrary::GeneralTermBond::dirtyPrice)
         .def("getDuration", &BondLibrary::GeneralTermBond::getDuration)
         .def("setYieldCurve", &BondLibrary::GeneralTermBond::setYieldCurve)
-        .def("isExpired", &BondLibrary::BaseBond::isExpired)
+        .def("isExpired", static_cast<IsExpired>(&BondLibrary::BaseBond::isExpired))
         .def("yieldToMaturity", &BondLibrary::BaseBond::yieldToMaturity);
+    class_<BondLibrary::ReplayStats>("ReplayStats", no_init)
+        .def_readonly("ticks", &BondLibrary::ReplayStats::ticks)
+        .def_readonly("prices", &BondLibrary::ReplayStats::prices)
+        .def_readonly("elapsed_seconds", &BondLibrary::ReplayStats::elapsed_seconds)
+        .def_readonly("ticks_per_second", &BondLibrary::ReplayStats::ticks_per_second)
+        .def_readonly("latency_p50", &BondLibrary::ReplayStats::latency_p50)
+        .def_readonly("latency_p90", &BondLibrary::ReplayStats::latency_p90)
+        .def_readonly("latency_p99", &BondLibrary::ReplayStats::latency_p99)
+        .def_readonly("latency_p999", &BondLibrary::ReplayStats::latency_p999)
+        .def_readonly("latency_max", &BondLibrary::ReplayStats::latency_max);
+    class_<BondLibrary::MarketDataReplay>("MarketDataReplay", init<Date>(arg("valuation_date")))
+        .def("addCurve", &BondLibrary::MarketDataReplay::addCurve, with_custodian_and_ward<1, 3>())
+        .def("addBond", &BondLibrary::MarketDataReplay::addBond, with_custodian_and_ward<1, 3>())
+        .def("run", &BondLibrary::MarketDataReplay::run, (
+            arg("input_path"), arg("output_path"), arg("recorded_speed")=false
+        ));
+    class_<BondLibrary::BondStore, boost::noncopyable>("BondStore", init<const std::string&>(arg("name")))
+        .def(init<const std::string&, size_t, size_t, size_t>((
+            arg("name"), arg("max_curves"), arg("max_bonds"), arg("max_cashflows")
+        )))
+        .def("remove", &BondLibrary::BondStore::remove)
+        .staticmethod("remove")
+        .def("publishCurve", &BondLibrary::BondStore::publishCurve)
+        .def("publishBond", &BondLibrary::BondStore::publishBond)
+        .def("cleanPrice", &BondLibrary::BondStore::cleanPrice)
+        .def("getDuration", &BondLibrary::BondStore::getDuration)
+        .def("curveCount", &BondLibrary::BondStore::curveCount)
+        .def("bondCount", &BondLibrary::BondStore::bondCount);
+    class_<BondLibrary::BatchBond>("BatchBond", no_init)
+        .def("cleanPrice", &BondLibrary::BatchBond::cleanPrice)
+        .def("dirtyPrice", &BondLibrary::BatchBond::dirtyPrice)
+        .def("getDuration", &BondLibrary::BatchBond::getDuration)
+        .def("yieldToMaturity", &BondLibrary::BatchBond::yieldToMaturity)
+        .def("isExpired", &BondLibrary::BatchBond::isExpired);
+    class_<BondLibrary::BondBatch, BondBatchWrapper, boost::noncopyable>("BondBatch", init<size_t, size_t>((
+            arg("expected_bonds"), arg("expected_cashflows")
+        )))
+        .def("addBond", batchAddBond, (
+            arg("face_value"), arg("coupon"), arg("maturity_date"), arg("issue_date"),
+            arg("schedule"), arg("settlement_date")=default_settlement,
+            arg("yield_curve"), arg("dc_convention")=DC::YearActualMonthActual
+        ))
+        .def("getBond", batchGetBond, with_custodian_and_ward_postcall<0, 1>())
+        .def("__len__", &BondLibrary::BondBatch::size)
+        .def("cleanPrices", batchCleanPrices)
+        .def("cleanPrices", batchCleanPricesInto, (arg("date"), arg("prices")))
+        .def("durations", batchDurations)
+        .def("durations", batchDurationsInto, (arg("date"), arg("durations")))
+        .def("release", batchRelease);
 }
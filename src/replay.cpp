@@ -0,0 +1,160 @@
+#include "replay.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+using namespace BondLibrary;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double percentile(const std::vector<int64_t>& sorted_ns, double q) {
+    if (sorted_ns.empty()) return 0.0;
+    const size_t i = std::min(sorted_ns.size() - 1, static_cast<size_t>(q * sorted_ns.size()));
+    return sorted_ns[i] / 1000.0;
+}
+
+// Sleeps most of the way to the release time and spins the rest, as sleep_until alone
+// overshoots by tens of microseconds
+void waitUntil(Clock::time_point release) {
+    const auto spin_window = std::chrono::microseconds(200);
+    if (release - Clock::now() > spin_window)
+        std::this_thread::sleep_until(release - spin_window);
+    while (Clock::now() < release) {}
+}
+}
+
+void MarketDataReplay::addCurve(const std::string& curve_id, YieldCurve& curve) {
+    if (curve_index_.count(curve_id))
+        throw std::runtime_error("Curve " + curve_id + " is already registered for replay");
+    curve_index_.emplace(curve_id, curves_.size());
+    curves_.push_back(&curve);
+}
+
+void MarketDataReplay::addBond(const std::string& bond_id, GeneralTermBond& bond) {
+    if (bond_index_.count(bond_id))
+        throw std::runtime_error("Bond " + bond_id + " is already registered for replay");
+    bond_index_.emplace(bond_id, bonds_.size());
+    bond_ids_.push_back(bond_id);
+    bonds_.push_back(&bond);
+}
+
+std::vector<MarketDataReplay::Tick> MarketDataReplay::loadTicks(const std::string& input_path) const {
+    std::ifstream file(input_path);
+    if (!file)
+        throw std::runtime_error("Could not open market data file " + input_path);
+    std::vector<Tick> ticks;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        if (line.empty() || line[0] == '#') continue;
+        std::vector<std::string> fields;
+        size_t last_pos = 0, pos = 0;
+        while ((pos = line.find(',', last_pos)) != std::string::npos) {
+            fields.push_back(line.substr(last_pos, pos - last_pos));
+            last_pos = pos + 1;
+        }
+        fields.push_back(line.substr(last_pos));
+        const std::string where = input_path + ":" + std::to_string(line_number);
+        if (fields.size() == 5 && fields[1] == "CURVE") {
+            const auto curve = curve_index_.find(fields[2]);
+            if (curve == curve_index_.end())
+                throw std::runtime_error("Unknown curve " + fields[2] + " at " + where);
+            // A NaN maturity would break the ordering the curve's interpolation searches on
+            const double maturity = std::stod(fields[3]);
+            const double bond_yield = std::stod(fields[4]);
+            if (!std::isfinite(maturity) || !std::isfinite(bond_yield))
+                throw std::runtime_error("Curve point must be finite at " + where);
+            ticks.push_back({std::stoll(fields[0]), true, curve->second, maturity, bond_yield});
+        }
+        else if (fields.size() == 4 && fields[1] == "QUOTE") {
+            const auto bond = bond_index_.find(fields[2]);
+            if (bond == bond_index_.end())
+                throw std::runtime_error("Unknown bond " + fields[2] + " at " + where);
+            // yieldToMaturity never brackets a root for a non-positive price
+            const double clean_price = std::stod(fields[3]);
+            if (!std::isfinite(clean_price) || clean_price <= 0.0)
+                throw std::runtime_error("Quote price must be finite and positive at " + where);
+            ticks.push_back({std::stoll(fields[0]), false, bond->second, clean_price, 0.0});
+        }
+        else {
+            throw std::runtime_error("Malformed market data record at " + where);
+        }
+    }
+    return ticks;
+}
+
+ReplayStats MarketDataReplay::run(const std::string& input_path, const std::string& output_path,
+ bool recorded_speed) const {
+    const std::vector<Tick> ticks = loadTicks(input_path);
+    std::vector<std::vector<size_t>> dependents(curves_.size());
+    for (size_t i = 0; i < bonds_.size(); ++i) {
+        const auto curve = std::find(curves_.begin(), curves_.end(), &bonds_[i]->getYieldCurve());
+        if (curve != curves_.end())
+            dependents[curve - curves_.begin()].push_back(i);
+    }
+    // The buffer outlives the stream, and is installed before open() as libstdc++ ignores
+    // setbuf on a filebuf that is already open
+    std::vector<char> output_buffer(1 << 20);
+    std::ofstream output;
+    output.rdbuf()->pubsetbuf(output_buffer.data(), output_buffer.size());
+    output.open(output_path);
+    if (!output)
+        throw std::runtime_error("Could not open replay output file " + output_path);
+
+    ReplayStats stats;
+    std::vector<int64_t> latencies;
+    latencies.reserve(ticks.size());
+    char record[128];
+    auto write = [&](int64_t timestamp, size_t bond, const char* kind, double value) {
+        const int len = std::snprintf(record, sizeof(record), "%lld,%s,%s,%.6f\n",
+            static_cast<long long>(timestamp), bond_ids_[bond].c_str(), kind, value);
+        output.write(record, std::min<int>(len, sizeof(record) - 1));
+        ++stats.prices;
+    };
+    const auto start = Clock::now();
+    for (const auto& tick : ticks) {
+        auto release = Clock::now();
+        if (recorded_speed) {
+            release = start + std::chrono::nanoseconds(tick.timestamp - ticks.front().timestamp);
+            waitUntil(release);
+        }
+        if (tick.curve_update) {
+            curves_[tick.target]->setPoint(tick.first, tick.second);
+            // Expiry is judged against the valuation date rather than the wall clock so a
+            // recorded day prices the same whenever it is replayed
+            for (const size_t bond : dependents[tick.target]) {
+                const GeneralTermBond& priced = *bonds_[bond];
+                write(tick.timestamp, bond, "PRICE", priced.isExpired(valuation_date_) ? 0.0
+                    : GeneralTermBond::presentValueOnCurve(priced.getCashFlows(),
+                        curves_[tick.target]->getYieldCurve(), valuation_date_));
+            }
+        }
+        else {
+            double ytm = std::numeric_limits<double>::quiet_NaN();
+            try {
+                ytm = bonds_[tick.target]->yieldToMaturity(tick.first, valuation_date_);
+            }
+            catch (const std::runtime_error&) {}
+            write(tick.timestamp, tick.target, "YIELD", ytm);
+        }
+        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - release).count());
+    }
+    output.flush();
+    stats.elapsed_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    stats.ticks = ticks.size();
+    stats.ticks_per_second = stats.elapsed_seconds > 0.0 ? stats.ticks / stats.elapsed_seconds : 0.0;
+    std::sort(latencies.begin(), latencies.end());
+    stats.latency_p50 = percentile(latencies, 0.5);
+    stats.latency_p90 = percentile(latencies, 0.9);
+    stats.latency_p99 = percentile(latencies, 0.99);
+    stats.latency_p999 = percentile(latencies, 0.999);
+    stats.latency_max = latencies.empty() ? 0.0 : latencies.back() / 1000.0;
+    return stats;
+}
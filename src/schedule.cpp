@@ -0,0 +1,76 @@
+#include "schedule.hpp"
+#include <stdexcept>
+
+using namespace BondLibrary;
+
+namespace {
+int dayNumber(const Date& date) {
+    return dayNumberFromDate(date.day, date.month, date.year);
+}
+
+double proRata(const Date& start, const Date& end, const Date& ref_start, const Date& ref_end) {
+    return static_cast<double>(dayNumber(end) - dayNumber(start))
+        / static_cast<double>(dayNumber(ref_end) - dayNumber(ref_start));
+}
+}
+
+void BondLibrary::generateSchedule(CashFlows& cashflows, double face_value,
+ double coupon, const Date& issue_date, const Date& maturity_date, const ScheduleRules& rules) {
+    if (!(issue_date < maturity_date))
+        throw std::runtime_error("Maturity date must be later than issue date");
+    const int frequency = static_cast<int>(rules.frequency);
+    const int step = 12 / frequency;
+    const double regular = coupon / frequency;
+    const bool long_stub = rules.stub_rule == StubRule::LongFront || rules.stub_rule == StubRule::LongBack;
+    const int months = (maturity_date.year - issue_date.year) * 12 + maturity_date.month - issue_date.month;
+    const size_t first = cashflows.size();
+    cashflows.reserve(first + months / step + 2);
+    if (rules.stub_rule == StubRule::ShortFront || rules.stub_rule == StubRule::LongFront) {
+        // Dates are rolled from the anchor by whole multiples of the step so that
+        // clamped month-ends (31st -> 30th) do not drift through the schedule.
+        auto rollBack = [&](int k) { return addMonths(maturity_date, -k * step, rules.end_of_month); };
+        int periods = 1;
+        while (issue_date < rollBack(periods))
+            ++periods;
+        const Date notional_start = rollBack(periods);
+        int k = periods - 1;
+        if (!(notional_start == issue_date)) {
+            const Date first_date = rollBack(k);
+            double amount = regular * proRata(issue_date, first_date, notional_start, first_date);
+            if (long_stub && k > 0) {
+                --k;
+                amount += regular;
+            }
+            cashflows.emplace_back(amount, rollBack(k--));
+        }
+        for (; k >= 0; --k)
+            cashflows.emplace_back(regular, rollBack(k));
+    }
+    else {
+        auto rollForward = [&](int k) { return addMonths(issue_date, k * step, rules.end_of_month); };
+        int periods = 1;
+        while (rollForward(periods) < maturity_date)
+            ++periods;
+        const Date notional_end = rollForward(periods);
+        int last = periods - 1;
+        if (!(notional_end == maturity_date) && long_stub && last > 0)
+            --last;
+        for (int k = 1; k <= last; ++k)
+            cashflows.emplace_back(regular, rollForward(k));
+        if (notional_end == maturity_date) {
+            cashflows.emplace_back(regular, maturity_date);
+        }
+        else {
+            const Date stub_start = rollForward(periods - 1);
+            double amount = regular * proRata(stub_start, maturity_date, stub_start, notional_end);
+            if (last < periods - 1)
+                amount += regular;
+            cashflows.emplace_back(amount, maturity_date);
+        }
+    }
+    cashflows.back().cashflow += face_value;
+    if (rules.calendar && rules.convention != BusinessDayConvention::Unadjusted) {
+        for (size_t i = first; i < cashflows.size(); ++i)
+            cashflows[i].due_date = rules.calendar->adjust(cashflows[i].due_date, rules.convention);
+    }
+}
@@ -172,6 +172,326 @@ class TestGeneralTermStucture:
         assert gtbond.getDuration(Date('01/01/2021')) == 3.52
 
 
+class TestSchedule:
+    def test_MatchesExplicitCashflows(self):
+        ftbond = FlatTermBond(
+            face_value = 100,
+            coupon = 10,
+            maturity_date = Date('12/10/2024'),
+            issue_date = Date('12/10/2021'),
+            settlement_date = Date('14/10/2021'),
+            schedule = ScheduleRules(Frequency.Annual)
+        )
+        assert ftbond.cleanPrice(0.09, Date('12/10/2021')) == 102.53
+    def test_ShortFrontStub(self):
+        ftbond = FlatTermBond(
+            face_value = 100,
+            coupon = 10,
+            maturity_date = Date('01/01/2024'),
+            issue_date = Date('01/03/2021'),
+            settlement_date = Date('03/03/2021'),
+            schedule = ScheduleRules(Frequency.Annual, StubRule.ShortFront)
+        )
+        assert ftbond.cleanPrice(0.0, Date('01/03/2021')) == 128.38
+    def test_LongBackStubEndOfMonth(self):
+        ftbond = FlatTermBond(
+            face_value = 100,
+            coupon = 4,
+            maturity_date = Date('15/05/2023'),
+            issue_date = Date('28/02/2021'),
+            settlement_date = Date('02/03/2021'),
+            schedule = ScheduleRules(Frequency.SemiAnnual, StubRule.LongBack, True)
+        )
+        assert ftbond.cleanPrice(0.0, Date('28/02/2021')) == 108.83
+    def test_MaturityBeforeIssueDate(self):
+        with pytest.raises(Exception):
+            FlatTermBond(
+                face_value = 100,
+                coupon = 5,
+                maturity_date = Date('10/10/2020'),
+                issue_date = Date('10/10/2021'),
+                schedule = ScheduleRules(Frequency.SemiAnnual)
+            )
+    def test_BadDayMonthYear(self):
+        for day, month, year in [(45, 2, 2023), (29, 2, 2023), (1, 13, 2021), (0, 1, 2021), (1, 1, 0)]:
+            with pytest.raises(Exception):
+                Date(day, month, year)
+        assert Date(29, 2, 2024) == Date('29/02/2024')
+
+class TestCalendar:
+    def test_BuiltInHolidays(self):
+        uk, us, target = Calendar('UK'), Calendar('US'), Calendar('TARGET')
+        assert uk.isHoliday(Date('08/05/2023'))
+        assert uk.isHoliday(Date('27/12/2022'))
+        assert us.isHoliday(Date('05/07/2021'))
+        assert us.isHoliday(Date('23/11/2023'))
+        assert target.isHoliday(Date('01/05/2023'))
+        assert target.isBusinessDay(Date('08/05/2023'))
+    def test_BusinessDaysBetween(self):
+        uk = Calendar('UK')
+        assert uk.businessDaysBetween(Date('01/12/2022'), Date('01/01/2023')) == 20
+        assert uk.businessDaysBetween(Date('01/01/2023'), Date('01/12/2022')) == -20
+    def test_Adjust(self):
+        uk = Calendar('UK')
+        assert uk.adjust(Date('31/12/2022'), BusinessDayConvention.Following) == Date('03/01/2023')
+        assert uk.adjust(Date('31/12/2022'), BusinessDayConvention.ModifiedFollowing) == Date('30/12/2022')
+        assert uk.adjust(Date('01/01/2023'), BusinessDayConvention.Preceding) == Date('30/12/2022')
+        assert uk.adjust(Date('01/01/2023'), BusinessDayConvention.ModifiedPreceding) == Date('03/01/2023')
+        assert uk.advance(Date('23/12/2022'), 2) == Date('29/12/2022')
+    def test_CustomCalendar(self):
+        custom = Calendar('Custom', [Date('02/01/2023')])
+        assert custom.isHoliday(Date('02/01/2023'))
+        custom.removeHoliday(Date('02/01/2023'))
+        assert custom.isBusinessDay(Date('02/01/2023'))
+        assert custom.isHoliday(Date('01/01/2023'))
+    def test_LoadHolidays(self, tmp_path):
+        holiday_file = tmp_path / 'holidays.txt'
+        holiday_file.write_text('# exchange closures\n03/01/2023\n\n04/01/2023\n')
+        custom = Calendar('Custom', [])
+        custom.loadHolidays(str(holiday_file))
+        assert custom.advance(Date('02/01/2023'), 1) == Date('05/01/2023')
+    def test_UnknownCalendar(self):
+        with pytest.raises(Exception):
+            Calendar('Mars')
+    def test_AdjustedSchedule(self):
+        uk = Calendar('UK')
+        ftbond = FlatTermBond(
+            face_value = 100,
+            coupon = 10,
+            maturity_date = Date('31/12/2022'),
+            issue_date = Date('31/12/2021'),
+            settlement_date = Date('04/01/2022'),
+            schedule = ScheduleRules(Frequency.SemiAnnual, StubRule.ShortFront, True, uk)
+        )
+        assert ftbond.cleanPrice(0.0, Date('31/12/2021')) == 110.0
+        assert ftbond.cleanPrice(0.0, Date('31/12/2022')) == 0.0
+
+class TestMarketDataReplay:
+    def makeReplay(self):
+        curve = YieldCurve([YieldCurvePoint(maturity = x + 1, bond_yield = 0.04) for x in range(4)])
+        gtbond = GeneralTermBond(
+            face_value = 100,
+            coupon = 5,
+            maturity_date = Date('01/01/2030'),
+            issue_date = Date('01/01/2025'),
+            schedule = ScheduleRules(Frequency.Annual),
+            yield_curve = curve
+        )
+        replay = MarketDataReplay(Date('01/01/2026'))
+        replay.addCurve('GBP', curve)
+        replay.addBond('UKT30', gtbond)
+        return replay, curve, gtbond
+    def test_Replay(self, tmp_path):
+        replay, curve, gtbond = self.makeReplay()
+        ticks = tmp_path / 'ticks.csv'
+        ticks.write_text(
+            '# timestamp_ns,type,id,values\n'
+            '1000,CURVE,GBP,2,0.045\n'
+            '2000,CURVE,GBP,6,0.05\n'
+            '3000,QUOTE,UKT30,99.5\n'
+        )
+        output = tmp_path / 'prices.csv'
+        stats = replay.run(str(ticks), str(output), recorded_speed = True)
+        records = [line.split(',') for line in output.read_text().splitlines()]
+        assert stats.ticks == 3 and stats.prices == 3
+        assert [r[2] for r in records] == ['PRICE', 'PRICE', 'YIELD']
+        assert float(records[1][3]) == pytest.approx(gtbond.cleanPrice(Date('01/01/2026')))
+        assert 0 <= stats.latency_p50 <= stats.latency_p99 <= stats.latency_max
+    def test_ReplayHistoricalDate(self, tmp_path):
+        curve = YieldCurve([YieldCurvePoint(maturity = x + 1, bond_yield = 0.04) for x in range(4)])
+        matured = GeneralTermBond(
+            face_value = 100,
+            coupon = 5,
+            maturity_date = Date('01/06/2025'),
+            issue_date = Date('01/06/2020'),
+            schedule = ScheduleRules(Frequency.Annual),
+            yield_curve = curve
+        )
+        replay = MarketDataReplay(Date('10/05/2023'))
+        replay.addCurve('GBP', curve)
+        replay.addBond('UKT25', matured)
+        ticks = tmp_path / 'ticks.csv'
+        ticks.write_text('1000,CURVE,GBP,2,0.045\n')
+        output = tmp_path / 'prices.csv'
+        replay.run(str(ticks), str(output))
+        price = float(output.read_text().split(',')[3])
+        assert 100 < price < 110
+    def test_BadQuotePrice(self, tmp_path):
+        replay = self.makeReplay()[0]
+        ticks = tmp_path / 'ticks.csv'
+        for price in ['-1.0', '0', 'nan', 'inf']:
+            ticks.write_text('1,QUOTE,UKT30,{}\n'.format(price))
+            with pytest.raises(Exception):
+                replay.run(str(ticks), str(tmp_path / 'prices.csv'))
+    def test_BadCurvePoint(self, tmp_path):
+        replay = self.makeReplay()[0]
+        ticks = tmp_path / 'ticks.csv'
+        for point in ['nan,0.045', 'inf,0.045', '2,nan', '2,-inf']:
+            ticks.write_text('1,CURVE,GBP,{}\n'.format(point))
+            with pytest.raises(RuntimeError, match = 'ticks.csv:1'):
+                replay.run(str(ticks), str(tmp_path / 'prices.csv'))
+    def test_UnknownCurve(self, tmp_path):
+        replay = self.makeReplay()[0]
+        ticks = tmp_path / 'ticks.csv'
+        ticks.write_text('1000,CURVE,USD,2,0.045\n')
+        with pytest.raises(Exception):
+            replay.run(str(ticks), str(tmp_path / 'prices.csv'))
+
+class TestBondStore:
+    def makeBond(self, curve):
+        return GeneralTermBond(
+            face_value = 100,
+            coupon = 5,
+            maturity_date = Date('01/01/2030'),
+            issue_date = Date('01/01/2025'),
+            schedule = ScheduleRules(Frequency.SemiAnnual),
+            yield_curve = curve
+        )
+    def test_PublishAndAttach(self):
+        name = '/bondpricer_test_{}'.format(os.getpid())
+        BondStore.remove(name)
+        try:
+            curve = YieldCurve([YieldCurvePoint(maturity = x + 1, bond_yield = 0.04) for x in range(4)])
+            gtbond = self.makeBond(curve)
+            loader = BondStore(name, max_curves = 4, max_bonds = 16, max_cashflows = 256)
+            loader.publishCurve('GBP', curve)
+            loader.publishBond('UKT30', gtbond, 'GBP')
+            worker = BondStore(name)
+            assert worker.bondCount() == 1 and worker.curveCount() == 1
+            assert worker.cleanPrice('UKT30', Date('01/01/2026')) == gtbond.cleanPrice(Date('01/01/2026'))
+            assert worker.getDuration('UKT30', Date('01/01/2026')) == gtbond.getDuration(Date('01/01/2026'))
+            curve.addToYieldCurve([YieldCurvePoint(5, 0.06)])
+            loader.publishCurve('GBP', curve)
+            assert worker.cleanPrice('UKT30', Date('01/01/2026')) == gtbond.cleanPrice(Date('01/01/2026'))
+            with pytest.raises(Exception):
+                worker.publishCurve('GBP', curve)
+            with pytest.raises(Exception):
+                worker.cleanPrice('UKT31', Date('01/01/2026'))
+        finally:
+            BondStore.remove(name)
+    @pytest.mark.skipif(not os.path.isdir('/dev/shm'), reason = 'needs /dev/shm to reach the store')
+    def test_LoaderDiedMidPublish(self):
+        import mmap, struct
+        name = '/bondpricer_test_{}'.format(os.getpid())
+        BondStore.remove(name)
+        try:
+            curve = YieldCurve([YieldCurvePoint(1, 0.04)])
+            loader = BondStore(name, 1, 1, 16)
+            loader.publishCurve('GBP', curve)
+            loader.publishBond('UKT30', self.makeBond(curve), 'GBP')
+            worker = BondStore(name)
+            # leave the first curve's sequence odd, as a loader killed inside publishCurve would
+            with open('/dev/shm' + name, 'r+b') as shm:
+                view = mmap.mmap(shm.fileno(), 0)
+                view[96:104] = struct.pack('Q', 1)
+                view.close()
+            with pytest.raises(Exception):
+                worker.cleanPrice('UKT30', Date('01/01/2026'))
+        finally:
+            BondStore.remove(name)
+    def test_BondOnDifferentCurve(self):
+        name = '/bondpricer_test_{}'.format(os.getpid())
+        BondStore.remove(name)
+        try:
+            gbp = YieldCurve([YieldCurvePoint(1, 0.04)])
+            usd = YieldCurve([YieldCurvePoint(1, 0.05)])
+            loader = BondStore(name, 2, 2, 32)
+            loader.publishCurve('GBP', gbp)
+            loader.publishCurve('USD', usd)
+            with pytest.raises(Exception):
+                loader.publishBond('UKT30', self.makeBond(gbp), 'USD')
+            loader.publishBond('UKT30', self.makeBond(gbp), 'GBP')
+            assert loader.bondCount() == 1
+        finally:
+            BondStore.remove(name)
+    def test_BondOnReallocatedCurve(self):
+        name = '/bondpricer_test_{}'.format(os.getpid())
+        BondStore.remove(name)
+        try:
+            loader = BondStore(name, 1, 2, 32)
+            gbp = YieldCurve([YieldCurvePoint(1, 0.04)])
+            loader.publishCurve('GBP', gbp)
+            del gbp
+            # Likely to land at the freed curve's address
+            other = YieldCurve([YieldCurvePoint(1, 0.20)])
+            with pytest.raises(Exception):
+                loader.publishBond('UKT30', self.makeBond(other), 'GBP')
+            assert loader.bondCount() == 0
+        finally:
+            BondStore.remove(name)
+    def test_BondBeforeCurve(self):
+        name = '/bondpricer_test_{}'.format(os.getpid())
+        BondStore.remove(name)
+        try:
+            curve = YieldCurve([YieldCurvePoint(1, 0.04)])
+            loader = BondStore(name, 1, 1, 16)
+            with pytest.raises(Exception):
+                loader.publishBond('UKT30', self.makeBond(curve), 'GBP')
+        finally:
+            BondStore.remove(name)
+
+class TestBondBatch:
+    def makeBatch(self, curve):
+        batch = BondBatch(expected_bonds = 8, expected_cashflows = 64)
+        for years in range(3, 7):
+            batch.addBond(
+                face_value = 100,
+                coupon = years,
+                maturity_date = Date(1, 1, 2025 + years),
+                issue_date = Date('01/01/2025'),
+                schedule = ScheduleRules(Frequency.SemiAnnual),
+                yield_curve = curve
+            )
+        return batch
+    def test_MatchesSingleBonds(self):
+        curve = YieldCurve([YieldCurvePoint(maturity = x + 1, bond_yield = 0.035 + 0.005 * x) for x in range(6)])
+        batch = self.makeBatch(curve)
+        prices = batch.cleanPrices(Date('01/01/2026'))
+        assert len(batch) == 4 and len(prices) == 4
+        for i in range(4):
+            assert prices[i] == batch.getBond(i).cleanPrice(Date('01/01/2026'))
+        durations = batch.durations(Date('01/01/2026'))
+        assert durations[3] == batch.getBond(3).getDuration(Date('01/01/2026'))
+    def test_PricesIntoBuffer(self):
+        import array
+        curve = YieldCurve([YieldCurvePoint(maturity = x + 1, bond_yield = 0.04) for x in range(6)])
+        batch = self.makeBatch(curve)
+        out = array.array('d', [0.0] * 4)
+        batch.cleanPrices(Date('01/01/2026'), out)
+        assert list(out) == list(batch.cleanPrices(Date('01/01/2026')))
+        with pytest.raises(Exception):
+            batch.cleanPrices(Date('01/01/2026'), array.array('d', [0.0]))
+        with pytest.raises(Exception):
+            batch.cleanPrices(Date('01/01/2026'), array.array('i', [0] * 4))
+    def test_CurveHeldOncePerBatch(self):
+        curve = YieldCurve([YieldCurvePoint(1, 0.04)])
+        refs = sys.getrefcount(curve)
+        batch = BondBatch(expected_bonds = 1000, expected_cashflows = 12000)
+        for _ in range(3):
+            for _ in range(1000):
+                batch.addBond(100, 5, Date('01/01/2030'), Date('01/01/2025'), ScheduleRules(), yield_curve = curve)
+            assert sys.getrefcount(curve) == refs + 1
+            batch.release()
+            assert sys.getrefcount(curve) == refs
+    def test_Release(self):
+        curve = YieldCurve([YieldCurvePoint(1, 0.04)])
+        batch = self.makeBatch(curve)
+        batch.release()
+        assert len(batch) == 0
+        with pytest.raises(Exception):
+            batch.getBond(0)
+        batch.addBond(100, 5, Date('01/01/2030'), Date('01/01/2025'), ScheduleRules(), yield_curve = curve)
+        assert len(batch) == 1 and len(batch.cleanPrices(Date('01/01/2026'))) == 1
+    def test_StaleHandleAfterRelease(self):
+        curve = YieldCurve([YieldCurvePoint(1, 0.04)])
+        batch = self.makeBatch(curve)
+        bond = batch.getBond(0)
+        assert bond.cleanPrice(Date('01/01/2026')) == batch.cleanPrices(Date('01/01/2026'))[0]
+        batch.release()
+        batch.addBond(100, 5, Date('01/01/2030'), Date('01/01/2025'), ScheduleRules(), yield_curve = curve)
+        with pytest.raises(Exception):
+            bond.cleanPrice(Date('01/01/2026'))
+
 class TestYieldCurves:
     def test_BadConstruction(self):
         with pytest.raises(Exception):